@@ -29,6 +29,34 @@ namespace odbc_scanner {
 
         static duckdb::idx_t GetRowCount(OdbcConnection odbc_conn, std::string table_name);
 
+        // Returns true if the driver accepts several SELECTs in one SQLExecDirect call
+        static bool SupportsSelectBatch(OdbcConnection &odbc_conn);
+
+        // Reads the driver's SQL_IDENTIFIER_QUOTE_CHAR; query it once and pass it to QuoteIdentifier
+        static std::string GetIdentifierQuote(OdbcConnection &odbc_conn);
+
+        static std::string QuoteIdentifier(const std::string &quote, const std::string &identifier);
+
+        // "catalog"."schema"."name", skipping the parts that are empty
+        static std::string QualifyName(const std::string &quote, const std::string &catalog,
+                                       const std::string &schema, const std::string &name);
+
+        static std::string GetDbmsName(OdbcConnection &odbc_conn);
+
+        // Returns "SELECT <select_list> FROM <from>" restricted to at most limit rows in the dialect of dbms_name
+        static std::string BuildLimitedSelect(const std::string &dbms_name, const std::string &select_list,
+                                              const std::string &from, duckdb::idx_t limit);
+
+        // Formats a percentage for a sample clause without exponent notation
+        static std::string FormatPercent(double percent);
+
+        // Returns the dialect's TABLESAMPLE/SAMPLE clause to append after "FROM <table>", or "" if unknown
+        static std::string GetNativeSampleClause(const std::string &dbms_name, double sample_percent);
+
+        // Returns a " WHERE ..." predicate keeping about sample_percent of the rows by key_expr modulo a bucket count
+        static std::string GetModuloSampleClause(const std::string &dbms_name, const std::string &key_expr,
+                                                 double sample_percent);
+
         // static unique_ptr<OdbcColumnBind> GetOdbcColumnBind(SQLSMALLINT sql_type, duckdb::idx_t size);
     };
 
@@ -52,6 +80,9 @@ namespace odbc_scanner {
         void Init(OdbcConnection odbc_conn);
         void SetFetchArraySize(const duckdb::idx_t &rows_per_fetch);
         void SetColumnBindOrientation();
+        void ExecDirect(const std::string &sql);
+        bool MoreResults();
+        void Close();
 
     public:
         SQLHSTMT hstmt = NULL; // Statement handle
@@ -5,11 +5,11 @@
 #include "duckdb/parser/parser.hpp"
 #include "duckdb/parser/expression/cast_expression.hpp"
 #include "duckdb/parser/parsed_data/create_table_function_info.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
 #include "duckdb/common/types/date.hpp"
 #include "duckdb/common/types/timestamp.hpp"
 
 #include "include/odbc_scanner_utils.hpp"
-#include "include/bound_columns.hpp"
 
 #include <sql.h>
 #include <sqlext.h>
@@ -25,38 +25,45 @@ using odbc_scanner::OdbcColumnBind;
 using odbc_scanner::OdbcColumnBindImpl;
 using odbc_scanner::OdbcScannerUtils;
 using odbc_scanner::OdbcStatement;
-using odbc_scanner::BoundColumns;
 
 #define STR_LEN 128 + 1
 
 struct OdbcBindData : public FunctionData {
     string conn_str;
     string table_name;
+    // optional catalog and schema of table_name, empty when not given
+    string catalog_name;
+    string schema_name;
 
     vector<string> names;
     vector<LogicalType> types;
     vector<SQLSMALLINT> odbc_sql_types;
-    vector<SQLSMALLINT> odbc_c_types;
 
     idx_t max_rowid = 0;
     vector<bool> not_nulls;
     vector<uint64_t> decimal_multipliers;
 
-    idx_t rows_per_group = 100000;
-    idx_t rows_per_fetch = 10;
+    // percentage of rows sampled on the remote side (100 = no sampling)
+    double sample_percent = 100;
+    // " FROM <table> [sample clause]"; the SELECT list is added in OdbcFunctionInit from the projected columns
+    string from_clause;
+    string identifier_quote;
 
     unique_ptr<FunctionData> Copy() const override {
         auto copy = make_unique<OdbcBindData>();
         copy->conn_str = conn_str;
         copy->table_name = table_name;
+        copy->catalog_name = catalog_name;
+        copy->schema_name = schema_name;
         copy->names = names;
         copy->types = types;
         copy->odbc_sql_types = odbc_sql_types;
         copy->max_rowid = max_rowid;
         copy->not_nulls = not_nulls;
         copy->decimal_multipliers = decimal_multipliers;
-        copy->rows_per_group = rows_per_group;
-        copy->rows_per_fetch = rows_per_fetch;
+        copy->sample_percent = sample_percent;
+        copy->from_clause = from_clause;
+        copy->identifier_quote = identifier_quote;
 
         return copy;
     }
@@ -64,11 +71,12 @@ struct OdbcBindData : public FunctionData {
     bool Equals(const FunctionData &other_p) const override {
         auto other = (OdbcBindData &)other_p;
         return other.conn_str == conn_str && other.table_name == table_name &&
+               other.catalog_name == catalog_name && other.schema_name == schema_name &&
                other.names == names && other.types == types && other.odbc_sql_types == odbc_sql_types &&
                other.max_rowid == max_rowid && other.not_nulls == not_nulls &&
                other.decimal_multipliers == decimal_multipliers &&
-               other.rows_per_group == rows_per_group &&
-               other.rows_per_fetch == rows_per_fetch;
+               other.sample_percent == sample_percent && other.from_clause == from_clause &&
+               other.identifier_quote == identifier_quote;
     }
 };
 
@@ -76,10 +84,104 @@ struct OdbcGlobalState : public GlobalTableFunctionState {
     OdbcGlobalState() : current_idx(0) {
     }
     idx_t current_idx;
+    bool done = false;
+    vector<column_t> column_ids;
+    unique_ptr<OdbcConnection> odbc_conn;
+    unique_ptr<OdbcStatement> odbc_stmt;
 };
 
 static unique_ptr<GlobalTableFunctionState> OdbcFunctionInit(ClientContext &context, TableFunctionInitInput &input) {
-    return make_unique<OdbcGlobalState>();
+    auto bind_data = (const OdbcBindData *)input.bind_data;
+    auto result = make_unique<OdbcGlobalState>();
+    result->column_ids = input.column_ids;
+
+    // only the columns DuckDB kept after projection pushdown are requested from the remote
+    string select_list;
+    for (auto column_id : input.column_ids) {
+        if (column_id == COLUMN_IDENTIFIER_ROW_ID) {
+            continue;
+        }
+        if (!select_list.empty()) {
+            select_list += ", ";
+        }
+        select_list += OdbcScannerUtils::QuoteIdentifier(bind_data->identifier_quote, bind_data->names[column_id]);
+    }
+    if (select_list.empty()) {
+        select_list = "1";
+    }
+
+    result->odbc_conn = make_unique<OdbcConnection>(bind_data->conn_str);
+    result->odbc_stmt = make_unique<OdbcStatement>(*result->odbc_conn);
+    result->odbc_stmt->ExecDirect("SELECT " + select_list + bind_data->from_clause);
+    return move(result);
+}
+
+// NULL/0 for an empty catalog or schema argument of the ODBC catalog functions
+#define OPTIONAL_NAME(name) (name).empty() ? NULL : (SQLCHAR *)(name).c_str(), (name).empty() ? 0 : SQL_NTS
+
+static bool IsIntegerType(SQLSMALLINT sql_type) {
+    return sql_type == SQL_INTEGER || sql_type == SQL_SMALLINT || sql_type == SQL_BIGINT;
+}
+
+static bool IsIntegerColumn(const OdbcBindData &bind_data, const string &col_name) {
+    for (idx_t col_idx = 0; col_idx < bind_data.names.size(); col_idx++) {
+        if (bind_data.names[col_idx] == col_name) {
+            return IsIntegerType(bind_data.odbc_sql_types[col_idx]);
+        }
+    }
+    return false;
+}
+
+// Picks the column for the modulo sampling fallback: an integer primary key column, then an integer column
+// leading a unique index, and only as a last resort the first integer column
+static string FindSampleKey(OdbcStatement &odbc_stmt, const OdbcBindData &bind_data) {
+    SQLCHAR col_name[STR_LEN];
+    SQLLEN len_col_name;
+    SQLSMALLINT ordinal_position;
+    SQLLEN len_ordinal_position;
+
+    auto rc = SQLBindCol(odbc_stmt.hstmt, 4, SQL_C_CHAR, col_name, STR_LEN, &len_col_name);
+    OdbcScannerUtils::CheckResult(rc, SQL_HANDLE_STMT, odbc_stmt.hstmt, "SQLBindCol failed.");
+    rc = SQLPrimaryKeys(odbc_stmt.hstmt, OPTIONAL_NAME(bind_data.catalog_name), OPTIONAL_NAME(bind_data.schema_name),
+                        (SQLCHAR *)bind_data.table_name.c_str(), SQL_NTS);
+    if (SQL_SUCCEEDED(rc)) {
+        while (SQLFetch(odbc_stmt.hstmt) == SQL_SUCCESS) {
+            if (IsIntegerColumn(bind_data, (const char *)col_name)) {
+                string key((const char *)col_name);
+                odbc_stmt.Close();
+                return key;
+            }
+        }
+    }
+    odbc_stmt.Close();
+
+    rc = SQLBindCol(odbc_stmt.hstmt, 8, SQL_C_SSHORT, &ordinal_position, 0, &len_ordinal_position);
+    OdbcScannerUtils::CheckResult(rc, SQL_HANDLE_STMT, odbc_stmt.hstmt, "SQLBindCol failed.");
+    rc = SQLBindCol(odbc_stmt.hstmt, 9, SQL_C_CHAR, col_name, STR_LEN, &len_col_name);
+    OdbcScannerUtils::CheckResult(rc, SQL_HANDLE_STMT, odbc_stmt.hstmt, "SQLBindCol failed.");
+    rc = SQLStatistics(odbc_stmt.hstmt, OPTIONAL_NAME(bind_data.catalog_name), OPTIONAL_NAME(bind_data.schema_name),
+                       (SQLCHAR *)bind_data.table_name.c_str(), SQL_NTS, SQL_INDEX_UNIQUE, SQL_QUICK);
+    if (SQL_SUCCEEDED(rc)) {
+        while (SQLFetch(odbc_stmt.hstmt) == SQL_SUCCESS) {
+            // the SQL_TABLE_STAT row has no column name
+            if (len_col_name == SQL_NULL_DATA || len_ordinal_position == SQL_NULL_DATA || ordinal_position != 1) {
+                continue;
+            }
+            if (IsIntegerColumn(bind_data, (const char *)col_name)) {
+                string key((const char *)col_name);
+                odbc_stmt.Close();
+                return key;
+            }
+        }
+    }
+    odbc_stmt.Close();
+
+    for (idx_t col_idx = 0; col_idx < bind_data.names.size(); col_idx++) {
+        if (IsIntegerType(bind_data.odbc_sql_types[col_idx])) {
+            return bind_data.names[col_idx];
+        }
+    }
+    return "";
 }
 
 static unique_ptr<FunctionData> OdbcBind(ClientContext &context, TableFunctionBindInput &input,
@@ -89,11 +191,28 @@ static unique_ptr<FunctionData> OdbcBind(ClientContext &context, TableFunctionBi
     result->conn_str = input.inputs[0].GetValue<string>();
     result->table_name = input.inputs[1].GetValue<string>();
 
+    string sample_key;
+    for (auto &kv : input.named_parameters) {
+        if (kv.first == "sample_percent") {
+            result->sample_percent = DoubleValue::Get(kv.second);
+            if (result->sample_percent <= 0 || result->sample_percent > 100) {
+                throw std::runtime_error("sample_percent must be in the range (0, 100].");
+            }
+        } else if (kv.first == "sample_key") {
+            sample_key = StringValue::Get(kv.second);
+        } else if (kv.first == "catalog") {
+            result->catalog_name = StringValue::Get(kv.second);
+        } else if (kv.first == "schema") {
+            result->schema_name = StringValue::Get(kv.second);
+        }
+    }
+
     OdbcConnection odbc_conn(result->conn_str);
     OdbcStatement odbc_stmt(odbc_conn);
 
     // https://docs.microsoft.com/en-us/sql/odbc/reference/syntax/sqlcolumns-function?view=sql-server-ver16#:~:text=DATA_TYPE%20(ODBC%201.0,and%20Standards%20Compliance.
-    auto rc = SQLColumns(odbc_stmt.hstmt, NULL, 0, NULL, 0, (SQLCHAR *)result->table_name.c_str(), SQL_NTS, NULL, 0);
+    auto rc = SQLColumns(odbc_stmt.hstmt, OPTIONAL_NAME(result->catalog_name), OPTIONAL_NAME(result->schema_name),
+                         (SQLCHAR *)result->table_name.c_str(), SQL_NTS, NULL, 0);
     OdbcScannerUtils::CheckResult(rc, SQL_HANDLE_STMT, odbc_stmt.hstmt);
 
     SQLCHAR col_name[STR_LEN];
@@ -140,15 +259,49 @@ static unique_ptr<FunctionData> OdbcBind(ClientContext &context, TableFunctionBi
 
         bool not_null = (bool)nullable;
         result->not_nulls.emplace_back(not_null);
-
-        result->odbc_c_types.emplace_back(OdbcScannerUtils::GetCDataType(data_type));
     }
-
-    result->max_rowid = OdbcScannerUtils::GetRowCount(odbc_conn, result->table_name);
+    odbc_stmt.Close();
 
     result->names = names;
     result->types = return_types;
 
+    result->identifier_quote = OdbcScannerUtils::GetIdentifierQuote(odbc_conn);
+    auto remote_name = OdbcScannerUtils::QualifyName(result->identifier_quote, result->catalog_name,
+                                                     result->schema_name, result->table_name);
+    result->max_rowid = OdbcScannerUtils::GetRowCount(odbc_conn, remote_name);
+
+    result->from_clause = " FROM " + remote_name;
+    if (result->sample_percent < 100) {
+        // an explicit sample_key asks for the key-modulo predicate even where the dialect has TABLESAMPLE
+        auto dbms_name = OdbcScannerUtils::GetDbmsName(odbc_conn);
+        string sample_clause;
+        if (sample_key.empty()) {
+            sample_clause = OdbcScannerUtils::GetNativeSampleClause(dbms_name, result->sample_percent);
+        }
+        if (sample_clause.empty()) {
+            string key_expr;
+            if (!sample_key.empty()) {
+                if (!IsIntegerColumn(*result, sample_key)) {
+                    throw std::runtime_error("sample_key: \"" + sample_key + "\" is not an integer column of " +
+                                             result->table_name);
+                }
+                key_expr = OdbcScannerUtils::QuoteIdentifier(result->identifier_quote, sample_key);
+            } else if (dbms_name.find("SQLite") != string::npos) {
+                key_expr = "rowid";
+            } else {
+                sample_key = FindSampleKey(odbc_stmt, *result);
+                if (sample_key.empty()) {
+                    throw std::runtime_error("sample_percent: " + dbms_name +
+                                             " has no known TABLESAMPLE syntax and " + result->table_name +
+                                             " has no integer column; set sample_key.");
+                }
+                key_expr = OdbcScannerUtils::QuoteIdentifier(result->identifier_quote, sample_key);
+            }
+            sample_clause = OdbcScannerUtils::GetModuloSampleClause(dbms_name, key_expr, result->sample_percent);
+        }
+        result->from_clause += sample_clause;
+    }
+
     return move(result);
 }
 
@@ -156,92 +309,87 @@ static unique_ptr<NodeStatistics> OdbcCardinality(ClientContext &context, const
     D_ASSERT(bind_data_p);
 
     auto bind_data = (const OdbcBindData *)bind_data_p;
-    return make_unique<NodeStatistics>(bind_data->max_rowid);
+    return make_unique<NodeStatistics>((idx_t)(bind_data->max_rowid * bind_data->sample_percent / 100));
 }
 
-static void OdbcScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
-    auto bind_data = (const OdbcBindData *)data.bind_data;
-    OdbcConnection odbc_conn(bind_data->conn_str);
-    OdbcStatement odbc_stmt(odbc_conn);
-    odbc_stmt.SetFetchArraySize(bind_data->rows_per_fetch);
-    odbc_stmt.SetColumnBindOrientation();
-
-    auto num_cols = output.ColumnCount();
-    // vector<unique_ptr<OdbcColumnBind>> bound_columns;
-    // for (idx_t col_idx = 0; col_idx < num_cols; col_idx++) {
-    //     switch (bind_data->odbc_sql_types[col_idx]) {
-    //     case SQL_INTEGER:
-    //         bound_columns.emplace_back(make_unique<OdbcColumnBindImpl<SQLINTEGER>>(bind_data->rows_per_fetch));
-    //         break;
-    //     case SQL_DECIMAL:
-    //         bound_columns.emplace_back(make_unique<OdbcColumnBindImpl<SQLDOUBLE>>(bind_data->rows_per_fetch));
-    //         break;
-    //     case SQL_CHAR:
-    //         bound_columns.emplace_back(make_unique<OdbcColumnBindImpl<SQLCHAR>>(bind_data->rows_per_fetch));
-    //         break;
-    //     case SQL_VARCHAR:
-    //     default:
-    //         bound_columns.emplace_back(make_unique<OdbcColumnBindImpl<SQLCHAR *>>(bind_data->rows_per_fetch));
-    //         break;
-    //     }
-    // }
-    BoundColumns bound_cols;
-    for (idx_t col_idx = 0; col_idx < num_cols; col_idx++) {
-        switch (bind_data->odbc_sql_types[col_idx]) {
-        case SQL_INTEGER: {
-            auto odbc_c_type = bind_data->odbc_c_types[col_idx];
-            auto col_val_ptr = bound_cols.GetDataPtr<SQLINTEGER>(col_idx);
-            auto col_ind_ptr = bound_cols.GetIndicatorPtr(col_idx);
-            auto col_val_ptr2 = bound_cols.GetDataPtr<SQLINTEGER>(col_idx);
-            if(col_val_ptr2){
-                ;
+static Value GetColumnValue(OdbcStatement &odbc_stmt, SQLUSMALLINT col_no, SQLSMALLINT sql_type,
+                            const LogicalType &type) {
+    SQLLEN ind;
+    SQLRETURN rc;
+    switch (sql_type) {
+    case SQL_INTEGER: {
+        SQLINTEGER value;
+        rc = SQLGetData(odbc_stmt.hstmt, col_no, SQL_C_SLONG, &value, 0, &ind);
+        OdbcScannerUtils::CheckResult(rc, SQL_HANDLE_STMT, odbc_stmt.hstmt, "SQLGetData failed.");
+        return ind == SQL_NULL_DATA ? Value(type) : Value::INTEGER(value);
+    }
+    case SQL_DECIMAL: {
+        SQLDOUBLE value;
+        rc = SQLGetData(odbc_stmt.hstmt, col_no, SQL_C_DOUBLE, &value, 0, &ind);
+        OdbcScannerUtils::CheckResult(rc, SQL_HANDLE_STMT, odbc_stmt.hstmt, "SQLGetData failed.");
+        return ind == SQL_NULL_DATA ? Value(type) : Value::DOUBLE(value).CastAs(type);
+    }
+    default: {
+        // strings longer than the buffer are returned in pieces (SQL_SUCCESS_WITH_INFO)
+        string value;
+        char buffer[1024];
+        do {
+            rc = SQLGetData(odbc_stmt.hstmt, col_no, SQL_C_CHAR, buffer, sizeof(buffer), &ind);
+            if (rc == SQL_NO_DATA) {
+                break;
             }
-
-            auto vec_values = bound_cols.GetVecValues<SQLINTEGER>(col_idx);
-            if (vec_values.empty()) {
-                ;
+            OdbcScannerUtils::CheckResult(rc, SQL_HANDLE_STMT, odbc_stmt.hstmt, "SQLGetData failed.");
+            if (ind == SQL_NULL_DATA) {
+                return Value(type);
             }
-
-
-            auto rc = SQLBindCol(odbc_stmt.hstmt, 1, odbc_c_type, col_val_ptr, 0, col_ind_ptr);
-            OdbcScannerUtils::CheckResult(rc, SQL_HANDLE_DBC, odbc_conn.hconn, "SQLBindCol failed");
-            break;
-        }
-        case SQL_DECIMAL:
-            bound_cols.GetDataPtr<SQLDOUBLE>(col_idx);
-            break;
-        case SQL_CHAR:
-            bound_cols.GetDataPtr<SQLCHAR>(col_idx);
-            break;
-        case SQL_VARCHAR:
-        default:
-            bound_cols.GetDataPtr<SQLCHAR *>(col_idx);
-            break;
-        }
+            value += buffer;
+        } while (rc == SQL_SUCCESS_WITH_INFO);
+        return Value(value).CastAs(type);
     }
-
-    // How to bind COL?
-    for (idx_t col_idx = 0; col_idx < num_cols; col_idx++) {
-        // auto odbc_c_type = bind_data->odbc_c_types[col_idx];
-        // auto col_val_ptr = bound_columns[col_idx].get();
-        // auto data = ((OdbcColumnBindImpl<> *)col_val_ptr)->GetData();
-        // SQLBindCol(odbc_stmt.hstmt, 1, odbc_c_type, OrderIDArray, 0, OrderIDIndArray);
     }
+}
 
-    // auto sql = StringUtil::Format("SELECT * FROM \"%s\"", bind_data->table_name);
-
-    while (SQLFetch(odbc_stmt.hstmt) == SQL_SUCCESS) {
-        for (idx_t col_idx = 0; col_idx < output.ColumnCount(); col_idx++) {
+static void OdbcScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+    auto bind_data = (const OdbcBindData *)data.bind_data;
+    auto &state = (OdbcGlobalState &)*data.global_state;
+    if (state.done) {
+        return;
+    }
 
+    auto &odbc_stmt = *state.odbc_stmt;
+    idx_t out_idx = 0;
+    while (out_idx < STANDARD_VECTOR_SIZE) {
+        auto rc = SQLFetch(odbc_stmt.hstmt);
+        if (rc == SQL_NO_DATA) {
+            state.done = true;
+            break;
         }
+        OdbcScannerUtils::CheckResult(rc, SQL_HANDLE_STMT, odbc_stmt.hstmt, "SQLFetch failed.");
+
+        // result set columns follow column_ids, minus the row id which is generated locally
+        SQLUSMALLINT col_no = 1;
+        for (idx_t col_idx = 0; col_idx < state.column_ids.size(); col_idx++) {
+            auto column_id = state.column_ids[col_idx];
+            if (column_id == COLUMN_IDENTIFIER_ROW_ID) {
+                output.SetValue(col_idx, out_idx, Value::BIGINT(state.current_idx + out_idx));
+                continue;
+            }
+            output.SetValue(col_idx, out_idx,
+                            GetColumnValue(odbc_stmt, col_no++, bind_data->odbc_sql_types[column_id],
+                                           bind_data->types[column_id]));
+        }
+        out_idx++;
     }
+    state.current_idx += out_idx;
+    output.SetCardinality(out_idx);
 }
 
 static string OdbcToString(const FunctionData *bind_data_p) {
     D_ASSERT(bind_data_p);
     auto bind_data = (const OdbcBindData *)bind_data_p;
     return StringUtil::Format("%s:%s", bind_data->conn_str,
-                              bind_data->table_name);
+                              bind_data->table_name) +
+           (bind_data->sample_percent < 100 ? StringUtil::Format(" (sample %g%%)", bind_data->sample_percent) : "");
 }
 
 class OdbcScanFunction : public TableFunction {
@@ -252,6 +400,10 @@ public:
         cardinality = OdbcCardinality;
         to_string = OdbcToString;
         projection_pushdown = true;
+        named_parameters["sample_percent"] = LogicalType::DOUBLE;
+        named_parameters["sample_key"] = LogicalType::VARCHAR;
+        named_parameters["catalog"] = LogicalType::VARCHAR;
+        named_parameters["schema"] = LogicalType::VARCHAR;
     }
 };
 
@@ -262,6 +414,8 @@ struct AttachFunctionData : public TableFunctionData
     bool finished = false;
     bool overwrite = false;
     string connecton_str = "";
+    // tables with fewer rows are copied into local tables instead of odbc_scan views (0 = disabled)
+    idx_t materialize_below = 0;
 };
 
 static unique_ptr<FunctionData> AttachBind(ClientContext &context,
@@ -278,6 +432,10 @@ static unique_ptr<FunctionData> AttachBind(ClientContext &context,
         {
             result->overwrite = BooleanValue::Get(kv.second);
         }
+        else if (kv.first == "materialize_below")
+        {
+            result->materialize_below = UBigIntValue::Get(kv.second);
+        }
     }
 
     return_types.push_back(LogicalType::BOOLEAN);
@@ -285,6 +443,161 @@ static unique_ptr<FunctionData> AttachBind(ClientContext &context,
     return move(result);
 }
 
+struct RemoteTable {
+    string catalog;
+    string schema;
+    string name;
+};
+
+static string RemoteName(const string &quote, const RemoteTable &table) {
+    return OdbcScannerUtils::QualifyName(quote, table.catalog, table.schema, table.name);
+}
+
+// Local objects keep the bare table name in the default schema, as odbc_attach always did
+static string LocalName(const RemoteTable &table) {
+    return KeywordHelper::WriteOptionallyQuoted(table.name);
+}
+
+static void RunQuery(Connection &dconn, const string &sql) {
+    auto res = dconn.Query(sql);
+    if (res->HasError()) {
+        res->ThrowError();
+    }
+}
+
+// With overwrite, a name can switch between view and table across attaches, and DuckDB cannot replace an
+// object of one kind with the other, so drop the existing object first
+static void DropOtherKind(Connection &dconn, const RemoteTable &table, bool creating_view) {
+    auto stmt = dconn.Prepare("SELECT table_type FROM information_schema.tables "
+                              "WHERE table_schema = ? AND table_name = ?");
+    if (stmt->HasError()) {
+        throw std::runtime_error(stmt->GetError());
+    }
+    auto res = stmt->Execute(DEFAULT_SCHEMA, table.name);
+    if (res->HasError()) {
+        res->ThrowError();
+    }
+    auto chunk = res->Fetch();
+    if (!chunk || chunk->size() == 0) {
+        return;
+    }
+    bool is_view = chunk->GetValue(0, 0).ToString() == "VIEW";
+    if (is_view != creating_view) {
+        RunQuery(dconn, (is_view ? "DROP VIEW " : "DROP TABLE ") + LocalName(table));
+    }
+}
+
+// Joins the statements into one multi-statement batch, e.g. "SELECT * FROM a; SELECT * FROM b"
+static string BuildBatch(const vector<string> &statements) {
+    string sql;
+    for (auto &statement : statements) {
+        if (!sql.empty()) {
+            sql += "; ";
+        }
+        sql += statement;
+    }
+    return sql;
+}
+
+// Counts at most limit rows of every table in a single round trip, walking the result sets with SQLMoreResults.
+// The probe is bounded so large tables, which stay views anyway, are not scanned in full.
+static vector<idx_t> ProbeRowCounts(OdbcConnection &odbc_conn, OdbcStatement &odbc_stmt, const string &quote,
+                                    const vector<RemoteTable> &tables, idx_t limit) {
+    auto dbms_name = OdbcScannerUtils::GetDbmsName(odbc_conn);
+    vector<string> statements;
+    for (auto &table : tables) {
+        auto probe = OdbcScannerUtils::BuildLimitedSelect(dbms_name, "1 AS probe_col", RemoteName(quote, table), limit);
+        statements.emplace_back("SELECT COUNT(*) FROM (" + probe + ") probe");
+    }
+
+    vector<idx_t> row_counts;
+    odbc_stmt.ExecDirect(BuildBatch(statements));
+    do {
+        SQLBIGINT count = 0;
+        SQLLEN ind_count;
+        auto rc = SQLFetch(odbc_stmt.hstmt);
+        OdbcScannerUtils::CheckResult(rc, SQL_HANDLE_STMT, odbc_stmt.hstmt, "SQLFetch failed.");
+        rc = SQLGetData(odbc_stmt.hstmt, 1, SQL_C_SBIGINT, &count, 0, &ind_count);
+        OdbcScannerUtils::CheckResult(rc, SQL_HANDLE_STMT, odbc_stmt.hstmt, "SQLGetData failed.");
+        row_counts.emplace_back(ind_count == SQL_NULL_DATA ? 0 : (idx_t)count);
+    } while (odbc_stmt.MoreResults());
+    odbc_stmt.Close();
+
+    if (row_counts.size() != tables.size()) {
+        throw std::runtime_error("odbc_attach: the driver returned an unexpected number of result sets.");
+    }
+    return row_counts;
+}
+
+// Copies the current result set of odbc_stmt into a new local table
+static void MaterializeResultSet(Connection &dconn, OdbcStatement &odbc_stmt, const RemoteTable &table,
+                                 bool overwrite) {
+    SQLSMALLINT num_cols;
+    auto rc = SQLNumResultCols(odbc_stmt.hstmt, &num_cols);
+    OdbcScannerUtils::CheckResult(rc, SQL_HANDLE_STMT, odbc_stmt.hstmt, "SQLNumResultCols failed.");
+
+    vector<SQLSMALLINT> sql_types;
+    vector<LogicalType> types;
+    string create_sql = overwrite ? "CREATE OR REPLACE TABLE " : "CREATE TABLE ";
+    create_sql += LocalName(table) + " (";
+    for (SQLSMALLINT col_no = 1; col_no <= num_cols; col_no++) {
+        SQLCHAR col_name[STR_LEN];
+        SQLSMALLINT len_col_name;
+        SQLSMALLINT data_type;
+        SQLULEN column_size;
+        SQLSMALLINT decimal_digits;
+        SQLSMALLINT nullable;
+        rc = SQLDescribeCol(odbc_stmt.hstmt, col_no, col_name, STR_LEN, &len_col_name, &data_type, &column_size,
+                            &decimal_digits, &nullable);
+        OdbcScannerUtils::CheckResult(rc, SQL_HANDLE_STMT, odbc_stmt.hstmt, "SQLDescribeCol failed.");
+
+        sql_types.emplace_back(data_type);
+        types.push_back(OdbcScannerUtils::GetLogicalType(data_type));
+        if (col_no > 1) {
+            create_sql += ", ";
+        }
+        create_sql += KeywordHelper::WriteOptionallyQuoted((const char *)col_name) + " " + types.back().ToString();
+    }
+    create_sql += ")";
+
+    if (overwrite) {
+        DropOtherKind(dconn, table, false);
+    }
+    RunQuery(dconn, create_sql);
+
+    Appender appender(dconn, table.name);
+    while ((rc = SQLFetch(odbc_stmt.hstmt)) != SQL_NO_DATA) {
+        OdbcScannerUtils::CheckResult(rc, SQL_HANDLE_STMT, odbc_stmt.hstmt, "SQLFetch failed.");
+        appender.BeginRow();
+        for (SQLSMALLINT col_no = 1; col_no <= num_cols; col_no++) {
+            appender.Append(GetColumnValue(odbc_stmt, col_no, sql_types[col_no - 1], types[col_no - 1]));
+        }
+        appender.EndRow();
+    }
+    appender.Close();
+}
+
+// Loads all given tables with one "SELECT * FROM a; SELECT * FROM b; ..." batch
+static void MaterializeTables(Connection &dconn, OdbcStatement &odbc_stmt, const string &quote,
+                              const vector<RemoteTable> &tables, bool overwrite) {
+    if (tables.empty()) {
+        return;
+    }
+    vector<string> statements;
+    for (auto &table : tables) {
+        statements.emplace_back("SELECT * FROM " + RemoteName(quote, table));
+    }
+    odbc_stmt.ExecDirect(BuildBatch(statements));
+    idx_t table_idx = 0;
+    do {
+        if (table_idx >= tables.size()) {
+            throw std::runtime_error("odbc_attach: the driver returned an unexpected number of result sets.");
+        }
+        MaterializeResultSet(dconn, odbc_stmt, tables[table_idx++], overwrite);
+    } while (odbc_stmt.MoreResults());
+    odbc_stmt.Close();
+}
+
 static void AttachFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
     auto &data = (AttachFunctionData &)*data_p.bind_data;
     if (data.finished) {
@@ -298,24 +611,70 @@ static void AttachFunction(ClientContext &context, TableFunctionInput &data_p, D
     // OdbcScannerUtils::OdbcConnect(odbc_conn, data.connecton_str);
     // OdbcScannerUtils::OdbcSetStmtHandle(odbc_conn);
 
+    SQLLEN ind_catalog_value;
+    SQLLEN ind_schema_value;
     SQLLEN ind_table_value;
+    char catalog_name[1024];
+    char schema_name[1024];
     char table_name[1024];
 
-    auto rc = SQLBindCol(odbc_stmt.hstmt, 3, SQL_C_CHAR, &table_name, sizeof(table_name), &ind_table_value);
+    auto rc = SQLBindCol(odbc_stmt.hstmt, 1, SQL_C_CHAR, &catalog_name, sizeof(catalog_name), &ind_catalog_value);
+    OdbcScannerUtils::CheckResult(rc, SQL_HANDLE_STMT, odbc_stmt.hstmt, "SQLBindCol failed.");
+    rc = SQLBindCol(odbc_stmt.hstmt, 2, SQL_C_CHAR, &schema_name, sizeof(schema_name), &ind_schema_value);
+    OdbcScannerUtils::CheckResult(rc, SQL_HANDLE_STMT, odbc_stmt.hstmt, "SQLBindCol failed.");
+    rc = SQLBindCol(odbc_stmt.hstmt, 3, SQL_C_CHAR, &table_name, sizeof(table_name), &ind_table_value);
     OdbcScannerUtils::CheckResult(rc, SQL_HANDLE_STMT, odbc_stmt.hstmt, "SQLBindCol failed.");
 
     // rc = SQLTables(odbc_conn.stmt, NULL, 0, (SQLCHAR *)"main", SQL_NTS, (SQLCHAR *)"%", SQL_NTS, (SQLCHAR *)"TABLE,VIEW", SQL_NTS);
     rc = SQLTables(odbc_stmt.hstmt, NULL, 0, NULL, 0, (SQLCHAR *)"%", SQL_NTS, (SQLCHAR *)"TABLE", SQL_NTS);
     OdbcScannerUtils::CheckResult(rc, SQL_HANDLE_STMT, odbc_stmt.hstmt);
 
+    vector<RemoteTable> tables;
     while (SQLFetch(odbc_stmt.hstmt) == SQL_SUCCESS) {
-        // if (ind_table_value != SQL_NULL_DATA) {
-        //   printf("Catalog Name = %s\n", table_name);
-        // }
+        RemoteTable table;
+        table.catalog = ind_catalog_value == SQL_NULL_DATA ? "" : catalog_name;
+        table.schema = ind_schema_value == SQL_NULL_DATA ? "" : schema_name;
+        table.name = table_name;
+        tables.emplace_back(table);
+    }
+    odbc_stmt.Close();
+
+    auto quote = OdbcScannerUtils::GetIdentifierQuote(odbc_conn);
+    vector<RemoteTable> view_tables;
+    vector<RemoteTable> materialize_tables;
+    if (data.materialize_below > 0 && !tables.empty()) {
+        if (!OdbcScannerUtils::SupportsSelectBatch(odbc_conn)) {
+            throw std::runtime_error("odbc_attach: materialize_below requires a driver with SELECT batch support.");
+        }
+        auto row_counts = ProbeRowCounts(odbc_conn, odbc_stmt, quote, tables, data.materialize_below);
+        for (idx_t i = 0; i < tables.size(); i++) {
+            if (row_counts[i] < data.materialize_below) {
+                materialize_tables.emplace_back(tables[i]);
+            } else {
+                view_tables.emplace_back(tables[i]);
+            }
+        }
+    } else {
+        view_tables = tables;
+    }
+
+    MaterializeTables(dconn, odbc_stmt, quote, materialize_tables, data.overwrite);
+
+    for (auto &table : view_tables) {
+        if (data.overwrite) {
+            DropOtherKind(dconn, table, true);
+        }
+        named_parameter_map_t scan_params;
+        if (!table.catalog.empty()) {
+            scan_params["catalog"] = Value(table.catalog);
+        }
+        if (!table.schema.empty()) {
+            scan_params["schema"] = Value(table.schema);
+        }
         auto scan_res = dconn.TableFunction("odbc_scan",
-                                            {Value(data.connecton_str), Value(table_name)});
+                                            {Value(data.connecton_str), Value(table.name)}, scan_params);
 
-        scan_res->CreateView(table_name, data.overwrite, false);
+        scan_res->CreateView(table.name, data.overwrite, false);
     }
 
     data.finished = true;
@@ -335,6 +694,7 @@ extern "C" {
         TableFunction attach_func("odbc_attach", {LogicalType::VARCHAR},
                                   AttachFunction, AttachBind);
         attach_func.named_parameters["overwrite"] = LogicalType::BOOLEAN;
+        attach_func.named_parameters["materialize_below"] = LogicalType::UBIGINT;
 
         CreateTableFunctionInfo attach_info(attach_func);
         catalog.CreateTableFunction(context, &attach_info);
@@ -4,6 +4,7 @@
 
 #include <sql.h>
 #include <sqlext.h>
+#include <cstdio>
 #include <stdexcept>
 #include <memory>
 
@@ -100,6 +101,130 @@ duckdb::idx_t OdbcScannerUtils::GetRowCount(OdbcConnection odbc_conn, std::strin
     return count;
 }
 
+bool OdbcScannerUtils::SupportsSelectBatch(OdbcConnection &odbc_conn) {
+    SQLUINTEGER batch_support = 0;
+    auto rc = SQLGetInfo(odbc_conn.hconn, SQL_BATCH_SUPPORT, &batch_support, sizeof(batch_support), NULL);
+    if (!SQL_SUCCEEDED(rc)) {
+        return false;
+    }
+    return (batch_support & SQL_BS_SELECT_EXPLICIT) != 0;
+}
+
+std::string OdbcScannerUtils::GetIdentifierQuote(OdbcConnection &odbc_conn) {
+    char quote_char[8] = "\"";
+    SQLSMALLINT quote_len;
+    auto rc = SQLGetInfo(odbc_conn.hconn, SQL_IDENTIFIER_QUOTE_CHAR, quote_char, sizeof(quote_char), &quote_len);
+    if (!SQL_SUCCEEDED(rc)) {
+        return "\"";
+    }
+    return std::string(quote_char);
+}
+
+std::string OdbcScannerUtils::QuoteIdentifier(const std::string &quote, const std::string &identifier) {
+    // a single space means the driver does not support quoted identifiers
+    if (quote.empty() || quote == " ") {
+        return identifier;
+    }
+
+    std::string result = quote;
+    for (auto c : identifier) {
+        if (quote.size() == 1 && c == quote[0]) {
+            result += c;
+        }
+        result += c;
+    }
+    return result + quote;
+}
+
+std::string OdbcScannerUtils::QualifyName(const std::string &quote, const std::string &catalog,
+                                          const std::string &schema, const std::string &name) {
+    std::string result;
+    if (!catalog.empty()) {
+        result += QuoteIdentifier(quote, catalog) + ".";
+    }
+    if (!schema.empty()) {
+        result += QuoteIdentifier(quote, schema) + ".";
+    }
+    return result + QuoteIdentifier(quote, name);
+}
+
+std::string OdbcScannerUtils::GetDbmsName(OdbcConnection &odbc_conn) {
+    char dbms_name[256];
+    SQLSMALLINT dbms_name_len;
+    auto rc = SQLGetInfo(odbc_conn.hconn, SQL_DBMS_NAME, dbms_name, sizeof(dbms_name), &dbms_name_len);
+    OdbcScannerUtils::CheckResult(rc, SQL_HANDLE_DBC, odbc_conn.hconn, "SQLGetInfo (SQL_DBMS_NAME) failed.");
+    return std::string(dbms_name);
+}
+
+std::string OdbcScannerUtils::BuildLimitedSelect(const std::string &dbms_name, const std::string &select_list,
+                                                 const std::string &from, duckdb::idx_t limit) {
+    auto limit_str = std::to_string(limit);
+    if (dbms_name.find("SQL Server") != std::string::npos) {
+        return "SELECT TOP " + limit_str + " " + select_list + " FROM " + from;
+    }
+    if (dbms_name.find("Oracle") != std::string::npos) {
+        return "SELECT " + select_list + " FROM " + from + " WHERE ROWNUM <= " + limit_str;
+    }
+    if (dbms_name.find("DB2") != std::string::npos) {
+        return "SELECT " + select_list + " FROM " + from + " FETCH FIRST " + limit_str + " ROWS ONLY";
+    }
+    return "SELECT " + select_list + " FROM " + from + " LIMIT " + limit_str;
+}
+
+std::string OdbcScannerUtils::FormatPercent(double percent) {
+    // fixed notation, since not every dialect accepts an exponent in a sample clause
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.6f", percent);
+    std::string result(buffer);
+    result.erase(result.find_last_not_of('0') + 1);
+    if (result.back() == '.') {
+        result.pop_back();
+    }
+    return result;
+}
+
+std::string OdbcScannerUtils::GetNativeSampleClause(const std::string &dbms_name, double sample_percent) {
+    std::string clause;
+    auto percent = FormatPercent(sample_percent);
+    if (dbms_name.find("PostgreSQL") != std::string::npos || dbms_name.find("DB2") != std::string::npos) {
+        clause = " TABLESAMPLE SYSTEM (" + percent + ")";
+    } else if (dbms_name.find("SQL Server") != std::string::npos) {
+        clause = " TABLESAMPLE (" + percent + " PERCENT)";
+    } else if (dbms_name.find("Oracle") != std::string::npos || dbms_name.find("Snowflake") != std::string::npos) {
+        clause = " SAMPLE (" + percent + ")";
+    } else {
+        return "";
+    }
+
+    // the smallest percentage Oracle accepts, and the precision FormatPercent keeps
+    if (sample_percent < 0.000001) {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%g", sample_percent);
+        throw std::runtime_error("sample_percent: " + std::string(buffer) + "% is below the smallest sample " +
+                                 dbms_name + " can express (0.000001%).");
+    }
+    return clause;
+}
+
+std::string OdbcScannerUtils::GetModuloSampleClause(const std::string &dbms_name, const std::string &key_expr,
+                                                    double sample_percent) {
+    // keep the rows whose key falls in the first sample_percent of SAMPLE_BUCKETS buckets; a small modulus spreads
+    // the kept rows over the whole key range instead of keeping a prefix of it
+    const long long SAMPLE_BUCKETS = 10000;
+    auto bucket_count = (long long)(sample_percent * SAMPLE_BUCKETS / 100);
+    if (bucket_count < 1) {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%g", sample_percent);
+        throw std::runtime_error("sample_percent: " + std::string(buffer) +
+                                 "% is below the smallest sample the modulo fallback can express (0.01%).");
+    }
+    auto buckets = std::to_string(SAMPLE_BUCKETS);
+    auto threshold = std::to_string(bucket_count);
+    if (dbms_name.find("SQLite") != std::string::npos) {
+        return " WHERE abs(" + key_expr + " % " + buckets + ") < " + threshold;
+    }
+    return " WHERE {fn ABS({fn MOD(" + key_expr + ", " + buckets + ")})} < " + threshold;
+}
 
 // unique_ptr<OdbcColumnBind> OdbcScannerUtils::GetOdbcColumnBind(SQLSMALLINT sql_type, duckdb::idx_t size) {
 //     if (sql_type == SQL_C_ULONG) {
@@ -168,4 +293,23 @@ void OdbcStatement::SetFetchArraySize(const duckdb::idx_t &rows_per_fetch) {
 void OdbcStatement::SetColumnBindOrientation() {
     auto rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_BIND_TYPE, SQL_BIND_BY_COLUMN, 0);
     OdbcScannerUtils::CheckResult(rc, SQL_HANDLE_STMT, hstmt, "SQLSetStmtAttr failed to set the SQL_ATTR_ROW_BIND_TYPE.");
+}
+
+void OdbcStatement::ExecDirect(const std::string &sql) {
+    auto rc = SQLExecDirect(hstmt, (SQLCHAR *)sql.c_str(), (SQLINTEGER)sql.size());
+    OdbcScannerUtils::CheckResult(rc, SQL_HANDLE_STMT, hstmt, "SQLExecDirect failed.");
+}
+
+bool OdbcStatement::MoreResults() {
+    auto rc = SQLMoreResults(hstmt);
+    if (rc == SQL_NO_DATA) {
+        return false;
+    }
+    OdbcScannerUtils::CheckResult(rc, SQL_HANDLE_STMT, hstmt, "SQLMoreResults failed.");
+    return true;
+}
+
+void OdbcStatement::Close() {
+    SQLFreeStmt(hstmt, SQL_CLOSE);
+    SQLFreeStmt(hstmt, SQL_UNBIND);
 }
\ No newline at end of file